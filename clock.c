@@ -37,9 +37,14 @@
 /* Global variable */
 struct TermClock term_clock;
 
+/*
+ * Bring the clock up in the order that gets its first frame on screen
+ * soonest: terminal, colors, frame window, first frame. The locale and
+ * the date window come afterwards (see date_init()), and whatever the
+ * options do not use (dial tables, color pairs) is never set up at all.
+ */
 void init(void) {
   struct sigaction sig;
-  setlocale(LC_TIME, "");
 
   term_clock.bg = COLOR_BLACK;
 
@@ -60,29 +65,23 @@ void init(void) {
   cbreak();
   noecho();
   keypad(stdscr, true);
-  start_color();
   curs_set(false);
+  nodelay(stdscr, true);
   clear();
+  /* Flushed along with the first frame */
+  wnoutrefresh(stdscr);
+  trace_phase("terminal");
 
   /* Init default terminal color */
+  start_color();
   if (use_default_colors() == OK)
     term_clock.bg = -1;
 
-  /* Init color pair */
-  init_pair(0, term_clock.bg, term_clock.bg);
-  init_pair(1, term_clock.bg, term_clock.option.color);
-  init_pair(2, term_clock.option.color, term_clock.bg);
-  //     init_pair(0, term_clock.bg, term_clock.bg);
-  //     init_pair(1, term_clock.bg, term_clock.option.color);
-  //     init_pair(2, term_clock.option.color, term_clock.bg);
-  refresh();
-
-  /* Init signal handler */
-  sig.sa_handler = signal_handler;
-  sig.sa_flags = 0;
-  sigaction(SIGTERM, &sig, NULL);
-  sigaction(SIGINT, &sig, NULL);
-  sigaction(SIGSEGV, &sig, NULL);
+  /* Init color pair cache, pairs are set up when first used */
+  term_clock.pairs.size =
+      (COLOR_PAIRS - 1 < PAIRCACHEMAX) ? COLOR_PAIRS - 1 : PAIRCACHEMAX;
+  term_clock.pairs.count = 0;
+  trace_phase("colors");
 
   /* Init global struct */
   term_clock.running = true;
@@ -94,18 +93,21 @@ void init(void) {
     term_clock.geo.a = 1;
   if (!term_clock.geo.b)
     term_clock.geo.b = 1;
-  term_clock.geo.w = (term_clock.option.second) ? SECFRAMEW : NORMFRAMEW;
-  term_clock.geo.h = 7;
-  term_clock.tm = localtime(&(term_clock.lt));
-  if (term_clock.option.utc) {
-    term_clock.tm = gmtime(&(term_clock.lt));
-  }
-  term_clock.lt = time(NULL);
+  clock_size(&term_clock.geo.w, &term_clock.geo.h);
   update_hour();
 
-  /* Create clock win */
+  /* Create clock win (again when the terminal was resized), right where
+   * it belongs so the first frame is drawn only once */
+  if (term_clock.option.center) {
+    term_clock.option.rebound = false;
+    clock_center(&term_clock.geo.x, &term_clock.geo.y);
+  }
+  if (term_clock.framewin)
+    delwin(term_clock.framewin);
   term_clock.framewin =
       newwin(term_clock.geo.h, term_clock.geo.w, term_clock.geo.x, term_clock.geo.y);
+  memset(term_clock.dialpos, -1, sizeof(term_clock.dialpos));
+  term_clock.dial_force = true;
   if (term_clock.option.box) {
     box(term_clock.framewin, 0, 0);
   }
@@ -114,25 +116,131 @@ void init(void) {
     wattron(term_clock.framewin, A_BLINK);
   }
 
+  if (term_clock.datewin) {
+    delwin(term_clock.datewin);
+    term_clock.datewin = NULL;
+  }
+  if (term_clock.calwin) {
+    delwin(term_clock.calwin);
+    term_clock.calwin = NULL;
+  }
+
+  trace_phase("frame");
+
+  /* First frame */
+  if (term_clock.option.analog)
+    draw_dial();
+  else
+    draw_digits();
+  trace_phase("first frame");
+
+  /* Init signal handler */
+  sig.sa_handler = signal_handler;
+  sig.sa_flags = 0;
+  sigemptyset(&sig.sa_mask);
+  sigaction(SIGTERM, &sig, NULL);
+  sigaction(SIGINT, &sig, NULL);
+  sigaction(SIGHUP, &sig, NULL);
+  sigaction(SIGSEGV, &sig, NULL);
+  trace_phase("signals");
+
+  if (term_clock.option.date)
+    date_init();
+
+  if (term_clock.option.calendar)
+    calendar_init();
+
+  /* Published datestr follows the locale too */
+  if (term_clock.shm)
+    locale_init();
+
+  return;
+}
+
+/* LC_TIME, only set up when the date or the calendar is shown */
+void locale_init(void) {
+  if (term_clock.locale)
+    return;
+
+  setlocale(LC_TIME, "");
+  term_clock.locale = true;
+  /* Keep old_datestr as is: no rollover, so no extra clock_move() */
+  termclock_format_date(&term_clock.ctx);
+  trace_phase("locale");
+
+  return;
+}
+
+/* Date window, only set up when the date is shown */
+void date_init(void) {
+  locale_init();
+
   /* Create the date win */
-  term_clock.datewin = newwin(DATEWINH, strlen(term_clock.date.datestr) + 2,
+  term_clock.datewin = newwin(DATEWINH, strlen(term_clock.ctx.date.datestr) + 2,
                             term_clock.geo.x + term_clock.geo.h - 1,
                             term_clock.geo.y + (term_clock.geo.w / 2) -
-                                (strlen(term_clock.date.datestr) / 2) - 1);
-  if (term_clock.option.box && term_clock.option.date) {
+                                (strlen(term_clock.ctx.date.datestr) / 2) - 1);
+  if (term_clock.option.box) {
     box(term_clock.datewin, 0, 0);
   }
   clearok(term_clock.datewin, true);
+  trace_phase("date window");
 
-  set_center(term_clock.option.center);
+  return;
+}
 
-  nodelay(stdscr, true);
+/* Calendar window, next to the frame (none if it does not fit) */
+void calendar_init(void) {
+  locale_init();
 
-  if (term_clock.option.date) {
-    wrefresh(term_clock.datewin);
+  term_clock.calwin = newwin(TERMCLOCK_CALH + 2, TERMCLOCK_CALW + 2, term_clock.geo.x,
+                             term_clock.geo.y + term_clock.geo.w + 1);
+  term_clock.cal_hidden = false;
+  if (term_clock.calwin) {
+    if (term_clock.option.box) {
+      box(term_clock.calwin, 0, 0);
+    }
+    /* Force a build in the (maybe new) locale */
+    term_clock.cal.year = -1;
+    draw_calendar(true);
   }
+  trace_phase("calendar");
 
-  wrefresh(term_clock.framewin);
+  return;
+}
+
+/* Record the time spent since the previous phase (see --startup-trace) */
+void trace_phase(const char *name) {
+  struct timespec now;
+
+  if (!term_clock.trace.enabled || term_clock.trace.done ||
+      term_clock.trace.count == TRACEMAX)
+    return;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  term_clock.trace.phase[term_clock.trace.count].name = name;
+  term_clock.trace.phase[term_clock.trace.count].ns =
+      (now.tv_sec - term_clock.trace.last.tv_sec) * 1000000000L +
+      (now.tv_nsec - term_clock.trace.last.tv_nsec);
+  ++term_clock.trace.count;
+  term_clock.trace.last = now;
+
+  return;
+}
+
+void trace_print(void) {
+  int i;
+  long total = 0;
+
+  if (!term_clock.trace.enabled)
+    return;
+
+  fprintf(stderr, "term-clock: startup trace (ms, phase / total)\n");
+  for (i = 0; i < term_clock.trace.count; ++i) {
+    total += term_clock.trace.phase[i].ns;
+    fprintf(stderr, "  %-12s %9.3f %9.3f\n", term_clock.trace.phase[i].name,
+            term_clock.trace.phase[i].ns / 1e6, total / 1e6);
+  }
 
   return;
 }
@@ -141,6 +249,7 @@ void signal_handler(int signal) {
   switch (signal) {
   case SIGINT:
   case SIGTERM:
+  case SIGHUP:
     term_clock.running = false;
     break;
     /* Segmentation fault signal */
@@ -159,115 +268,303 @@ void cleanup(void) {
     delscreen(term_clock.term_screen);
 
   free(term_clock.term);
+
+  if (term_clock.shm) {
+    termclock_shm_close(term_clock.shm);
+    shm_unlink(term_clock.shmname);
+  }
+  free(term_clock.shmname);
 }
 
 void update_hour(void) {
-  int ihour;
-  char tmpstr[128];
+  termclock_update(&term_clock.ctx, time(NULL));
+
+  return;
+}
+
+/* Terminal color number of a theme color */
+int term_color(unsigned int color) {
+  /* Direct color terminals take 0xrrggbb as color number */
+  if (COLORS >= 0x1000000 && (TERMCLOCK_ISRGB(color) || color >= 8))
+    return termclock_color_rgb(color);
+
+  return termclock_color_index(color, COLORS);
+}
 
-  term_clock.lt = time(NULL);
-  term_clock.tm = localtime(&(term_clock.lt));
-  if (term_clock.option.utc) {
-    term_clock.tm = gmtime(&(term_clock.lt));
+/*
+ * Color pair for fg/bg. Pairs are kept in a cache bounded by COLOR_PAIRS,
+ * so a color costs one init_pair() the first time it is used and the least
+ * recently used pair is recycled once the cache is full.
+ */
+int pair_get(int fg, int bg) {
+  int i, lru = 0;
+
+  ++term_clock.pairs.clock;
+
+  for (i = 0; i < term_clock.pairs.count; ++i) {
+    if (term_clock.pairs.pair[i].fg == fg && term_clock.pairs.pair[i].bg == bg) {
+      term_clock.pairs.pair[i].used = term_clock.pairs.clock;
+      return i + 1;
+    }
+    if (term_clock.pairs.pair[i].used < term_clock.pairs.pair[lru].used)
+      lru = i;
   }
 
-  ihour = term_clock.tm->tm_hour;
+  if (term_clock.pairs.size <= 0)
+    return 0;
 
-  if (term_clock.option.twelve)
-    term_clock.meridiem = ((ihour >= 12) ? PMSIGN : AMSIGN);
+  if (term_clock.pairs.count < term_clock.pairs.size)
+    i = term_clock.pairs.count++;
   else
-    term_clock.meridiem = "\0";
+    i = lru;
+
+  term_clock.pairs.pair[i].fg = fg;
+  term_clock.pairs.pair[i].bg = bg;
+  term_clock.pairs.pair[i].used = term_clock.pairs.clock;
+#if NCURSES_EXT_COLORS
+  init_extended_pair(i + 1, fg, bg);
+#else
+  init_pair(i + 1, fg, bg);
+#endif
+
+  return i + 1;
+}
 
-  /* Manage hour for twelve mode */
-  ihour = ((term_clock.option.twelve && ihour > 12) ? (ihour - 12) : ihour);
-  ihour = ((term_clock.option.twelve && !ihour) ? 12 : ihour);
+/* Color pair a rendered cell is drawn with */
+int cell_pair(const struct TermClockCell *cell) {
+  if (cell->lit)
+    return pair_get(term_clock.bg, term_color(cell->color));
+  if (cell->ch != ' ')
+    return pair_get(term_color(cell->color), term_clock.bg);
 
-  /* Set hour */
-  term_clock.date.hour[0] = ihour / 10;
-  term_clock.date.hour[1] = ihour % 10;
+  return 0;
+}
 
-  /* Set minutes */
-  term_clock.date.minute[0] = term_clock.tm->tm_min / 10;
-  term_clock.date.minute[1] = term_clock.tm->tm_min % 10;
+void draw_digits(void) {
+  int i, pair = 0, w = termclock_width(&term_clock.ctx);
+  unsigned int color = 0;
+  struct TermClockCell *cell;
 
-  /* Set date string */
-  strcpy(term_clock.date.old_datestr, term_clock.date.datestr);
-  strftime(tmpstr, sizeof(tmpstr), term_clock.option.format, term_clock.tm);
-  sprintf(term_clock.date.datestr, "%s%s", tmpstr, term_clock.meridiem);
+  /* Draw the numbers and dots rendered by libtermclock */
+  termclock_render(&term_clock.ctx, term_clock.cells, w, TERMCLOCK_DIGITH);
 
-  /* Set seconds */
-  term_clock.date.second[0] = term_clock.tm->tm_sec / 10;
-  term_clock.date.second[1] = term_clock.tm->tm_sec % 10;
+  if (term_clock.option.bold)
+    wattron(term_clock.framewin, A_BLINK);
+  else
+    wattroff(term_clock.framewin, A_BLINK);
+
+  for (i = 0; i < w * TERMCLOCK_DIGITH; ++i) {
+    cell = &term_clock.cells[i];
+    /* Cells mostly share their color with the previous one */
+    if (cell->lit && (!pair || cell->color != color)) {
+      color = cell->color;
+      pair = pair_get(term_clock.bg, term_color(color));
+    }
+    wbkgdset(term_clock.framewin, COLOR_PAIR(cell->lit ? pair : 0));
+    mvwaddch(term_clock.framewin, 1 + i / w, 1 + i % w, cell->ch);
+  }
+  wrefresh(term_clock.framewin);
 
   return;
 }
 
-void draw_number(int n, int x, int y) {
-  int i, sy = y;
+/*
+ * Draw the analog dial from the precomputed hand tables. Only the hands
+ * that moved are erased and drawn again; of the unmoved hands and of the
+ * marks, only the cells they share with those are redrawn on top. The
+ * whole dial is only drawn when forced (new window, color or bold change).
+ */
+void draw_dial(void) {
+  int i, n, hand, pos[3], at;
+  bool moved[3], any = false;
+  const struct TermClockPoint *p;
+  struct TermClockCell cell;
+
+  for (hand = TERMCLOCK_HAND_HOUR; hand <= TERMCLOCK_HAND_SECOND; ++hand) {
+    pos[hand] = (hand == TERMCLOCK_HAND_SECOND && !term_clock.ctx.option.second)
+                    ? -1
+                    : termclock_dial_pos(&term_clock.ctx, hand);
+    moved[hand] = term_clock.dial_force || pos[hand] != term_clock.dialpos[hand];
+    any = any || moved[hand];
+  }
 
-  for (i = 0; i < 30; ++i, ++sy) {
-    if (sy == y + 6) {
-      sy = y;
-      ++x;
-    }
+  if (!any)
+    return;
 
-    if (term_clock.option.bold)
-      wattron(term_clock.framewin, A_BLINK);
-    else
-      wattroff(term_clock.framewin, A_BLINK);
+  if (term_clock.option.bold)
+    wattron(term_clock.framewin, A_BLINK);
+  else
+    wattroff(term_clock.framewin, A_BLINK);
 
-    wbkgdset(term_clock.framewin, COLOR_PAIR(number[n][i / 2]));
-    mvwaddch(term_clock.framewin, x, sy, ' ');
+  /* Touched cells get this draw's stamp in dialmask */
+  if (++term_clock.dialstamp == 0) {
+    memset(term_clock.dialmask, 0, sizeof(term_clock.dialmask));
+    term_clock.dialstamp = 1;
   }
+
+  /* Erase the old cells of the hands that moved */
+  wbkgdset(term_clock.framewin, COLOR_PAIR(0));
+  for (hand = TERMCLOCK_HAND_HOUR; hand <= TERMCLOCK_HAND_SECOND; ++hand) {
+    if (!moved[hand] || term_clock.dialpos[hand] < 0)
+      continue;
+    p = termclock_dial_hand(&term_clock.dial, hand, term_clock.dialpos[hand], &n);
+    for (i = 0; i < n; ++i) {
+      term_clock.dialmask[p[i].row * term_clock.dial.w + p[i].col] =
+          term_clock.dialstamp;
+      mvwaddch(term_clock.framewin, 1 + p[i].row, 1 + p[i].col, ' ');
+    }
+  }
+
+  /* Marks, then hands from the second one up to the hour one: moved ones
+   * whole, the others only where something was touched below them */
+  for (hand = TERMCLOCK_HAND_MARK; hand >= TERMCLOCK_HAND_HOUR; --hand) {
+    if (hand != TERMCLOCK_HAND_MARK && pos[hand] < 0)
+      continue;
+    p = termclock_dial_hand(&term_clock.dial, hand,
+                            (hand == TERMCLOCK_HAND_MARK) ? 0 : pos[hand], &n);
+    for (i = 0; i < n; ++i) {
+      at = p[i].row * term_clock.dial.w + p[i].col;
+      if (hand == TERMCLOCK_HAND_MARK || !moved[hand]) {
+        if (!term_clock.dial_force &&
+            term_clock.dialmask[at] != term_clock.dialstamp)
+          continue;
+      } else {
+        term_clock.dialmask[at] = term_clock.dialstamp;
+      }
+      cell = termclock_dial_cell(&term_clock.ctx, &term_clock.dial, hand, p[i]);
+      wbkgdset(term_clock.framewin, COLOR_PAIR(cell_pair(&cell)));
+      mvwaddch(term_clock.framewin, 1 + p[i].row, 1 + p[i].col, cell.ch);
+    }
+  }
+
+  memcpy(term_clock.dialpos, pos, sizeof(pos));
+  term_clock.dial_force = false;
   wrefresh(term_clock.framewin);
 
   return;
 }
 
+/*
+ * Draw the month calendar: the whole pre-rendered block when full is set
+ * or the month changed, else only the previous and the new today cells.
+ */
+void draw_calendar(bool full) {
+  int i, pair;
+  struct TermClockPoint p;
+  struct tm *tm = &(term_clock.ctx.tm);
+
+  if (term_clock.cal_hidden)
+    return;
+
+  if (term_clock.cal.year != tm->tm_year || term_clock.cal.mon != tm->tm_mon) {
+    termclock_cal_build(&(term_clock.cal), tm);
+    full = true;
+  } else if (!full && term_clock.cal.mday == tm->tm_mday) {
+    return;
+  }
+
+  pair = pair_get(term_color(term_clock.ctx.theme.from), term_clock.bg);
+  wbkgdset(term_clock.calwin, COLOR_PAIR(pair));
+  wattroff(term_clock.calwin, A_REVERSE);
+
+  if (full) {
+    for (i = 0; i < TERMCLOCK_CALH; ++i)
+      mvwprintw(term_clock.calwin, 1 + i, 1, "%-*s", TERMCLOCK_CALW,
+                term_clock.cal.lines[i]);
+  } else {
+    p = termclock_cal_day(&(term_clock.cal), term_clock.cal.mday);
+    mvwaddnstr(term_clock.calwin, 1 + p.row, 1 + p.col,
+               &(term_clock.cal.lines[p.row][p.col]), 2);
+  }
+
+  /* Today */
+  term_clock.cal.mday = tm->tm_mday;
+  p = termclock_cal_day(&(term_clock.cal), term_clock.cal.mday);
+  wattron(term_clock.calwin, A_REVERSE);
+  mvwaddnstr(term_clock.calwin, 1 + p.row, 1 + p.col,
+             &(term_clock.cal.lines[p.row][p.col]), 2);
+  wattroff(term_clock.calwin, A_REVERSE);
+
+  term_clock.cal_force = false;
+  wrefresh(term_clock.calwin);
+
+  return;
+}
+
 void draw_clock(void) {
-  if (term_clock.option.date && !term_clock.option.rebound &&
-      strcmp(term_clock.date.datestr, term_clock.date.old_datestr) != 0) {
+  bool rollover =
+      strcmp(term_clock.ctx.date.datestr, term_clock.ctx.date.old_datestr) != 0;
+
+  if (term_clock.option.date && !term_clock.option.rebound && rollover) {
     clock_move(term_clock.geo.x, term_clock.geo.y, term_clock.geo.w, term_clock.geo.h);
   }
 
-  /* Draw hour numbers */
-  draw_number(term_clock.date.hour[0], 1, 1);
-  draw_number(term_clock.date.hour[1], 1, 8);
-  chtype dotcolor = COLOR_PAIR(1);
-  if (term_clock.option.blink && time(NULL) % 2 == 0)
-    dotcolor = COLOR_PAIR(2);
+  /* The calendar only changes on a new day, also caught when the date
+   * format leaves the day out */
+  if (term_clock.calwin &&
+      (term_clock.cal_force || rollover ||
+       term_clock.cal.mday != term_clock.ctx.tm.tm_mday))
+    draw_calendar(term_clock.cal_force);
 
-  /* 2 dot for number separation */
-  wbkgdset(term_clock.framewin, dotcolor);
-  mvwaddstr(term_clock.framewin, 2, 16, "  ");
-  mvwaddstr(term_clock.framewin, 4, 16, "  ");
-
-  /* Draw minute numbers */
-  draw_number(term_clock.date.minute[0], 1, 20);
-  draw_number(term_clock.date.minute[1], 1, 27);
+  if (term_clock.option.analog)
+    draw_dial();
+  else
+    draw_digits();
 
   /* Draw the date */
-  if (term_clock.option.bold)
-    wattron(term_clock.datewin, A_BOLD);
-  else
-    wattroff(term_clock.datewin, A_BOLD);
+  if (term_clock.datewin) {
+    if (term_clock.option.bold)
+      wattron(term_clock.datewin, A_BOLD);
+    else
+      wattroff(term_clock.datewin, A_BOLD);
 
-  if (term_clock.option.date) {
-    wbkgdset(term_clock.datewin, (COLOR_PAIR(2)));
-    mvwprintw(term_clock.datewin, (DATEWINH / 2), 1, "%s", term_clock.date.datestr);
+    wbkgdset(term_clock.datewin,
+             COLOR_PAIR(pair_get(term_color(term_clock.ctx.theme.from),
+                                 term_clock.bg)));
+    mvwprintw(term_clock.datewin, (DATEWINH / 2), 1, "%s", term_clock.ctx.date.datestr);
     wrefresh(term_clock.datewin);
   }
 
-  /* Draw second if the option is enabled */
-  if (term_clock.option.second) {
-    /* Again 2 dot for number separation */
-    wbkgdset(term_clock.framewin, dotcolor);
-    mvwaddstr(term_clock.framewin, 2, NORMFRAMEW, "  ");
-    mvwaddstr(term_clock.framewin, 4, NORMFRAMEW, "  ");
+  ++term_clock.frame;
+  if (term_clock.shm)
+    termclock_shm_publish(term_clock.shm, &term_clock.ctx, term_clock.frame);
+
+  return;
+}
+
+/* Rows the date window sticks out below the frame */
+int clock_overhang(void) {
+  return (term_clock.option.date) ? DATEWINH - 1 : 0;
+}
+
+/* Columns the calendar takes on the right of the frame */
+int clock_sidebar(void) {
+  return (term_clock.option.calendar) ? TERMCLOCK_CALW + 3 : 0;
+}
+
+/* Frame size of the clock, with its border */
+void clock_size(int *w, int *h) {
+  if (term_clock.option.analog) {
+    /* Dial tables are only rebuilt when the terminal size changes */
+    if (term_clock.dial_lines != LINES || term_clock.dial_cols != COLS) {
+      if (termclock_dial_build(&term_clock.dial,
+                               COLS - 2 - clock_sidebar(),
+                               LINES - 2 - clock_overhang()) == 0) {
+        term_clock.dial_lines = LINES;
+        term_clock.dial_cols = COLS;
+      } else {
+        term_clock.dial_lines = term_clock.dial_cols = 0;
+        term_clock.option.analog = false;
+      }
+    }
+  }
 
-    /* Draw second numbers */
-    draw_number(term_clock.date.second[0], 1, 39);
-    draw_number(term_clock.date.second[1], 1, 46);
+  if (term_clock.option.analog) {
+    *w = term_clock.dial.w + 2;
+    *h = term_clock.dial.h + 2;
+  } else {
+    *w = (term_clock.ctx.option.second) ? SECFRAMEW : NORMFRAMEW;
+    *h = 7;
   }
 
   return;
@@ -280,24 +577,32 @@ void clock_move(int x, int y, int w, int h) {
   wborder(term_clock.framewin, ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ');
   werase(term_clock.framewin);
   wrefresh(term_clock.framewin);
+  memset(term_clock.dialpos, -1, sizeof(term_clock.dialpos));
+  term_clock.dial_force = true;
 
-  if (term_clock.option.date) {
+  if (term_clock.datewin) {
     wbkgdset(term_clock.datewin, COLOR_PAIR(0));
     wborder(term_clock.datewin, ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ');
     werase(term_clock.datewin);
     wrefresh(term_clock.datewin);
   }
 
+  if (term_clock.calwin && !term_clock.cal_hidden) {
+    wbkgdset(term_clock.calwin, COLOR_PAIR(0));
+    werase(term_clock.calwin);
+    wrefresh(term_clock.calwin);
+  }
+
   /* Frame win move */
   mvwin(term_clock.framewin, (term_clock.geo.x = x), (term_clock.geo.y = y));
   wresize(term_clock.framewin, (term_clock.geo.h = h), (term_clock.geo.w = w));
 
   /* Date win move */
-  if (term_clock.option.date) {
+  if (term_clock.datewin) {
     mvwin(term_clock.datewin, term_clock.geo.x + term_clock.geo.h - 1,
           term_clock.geo.y + (term_clock.geo.w / 2) -
-              (strlen(term_clock.date.datestr) / 2) - 1);
-    wresize(term_clock.datewin, DATEWINH, strlen(term_clock.date.datestr) + 2);
+              (strlen(term_clock.ctx.date.datestr) / 2) - 1);
+    wresize(term_clock.datewin, DATEWINH, strlen(term_clock.ctx.date.datestr) + 2);
 
     if (term_clock.option.box) {
       box(term_clock.datewin, 0, 0);
@@ -309,7 +614,23 @@ void clock_move(int x, int y, int w, int h) {
   }
 
   wrefresh(term_clock.framewin);
-  wrefresh(term_clock.datewin);
+  if (term_clock.datewin)
+    wrefresh(term_clock.datewin);
+
+  /* Calendar win move, next to the frame. When it does not fit mvwin()
+   * leaves it in place, so keep it hidden instead of drawing it there */
+  if (term_clock.calwin) {
+    term_clock.cal_hidden =
+        mvwin(term_clock.calwin, term_clock.geo.x,
+              term_clock.geo.y + term_clock.geo.w + 1) == ERR;
+    if (!term_clock.cal_hidden) {
+      if (term_clock.option.box) {
+        wbkgdset(term_clock.calwin, COLOR_PAIR(0));
+        box(term_clock.calwin, 0, 0);
+      }
+      draw_calendar(true);
+    }
+  }
   return;
 }
 
@@ -324,7 +645,7 @@ void clock_rebound(void) {
     term_clock.geo.a = -1;
   if (term_clock.geo.y < 1)
     term_clock.geo.b = 1;
-  if (term_clock.geo.y > (COLS - term_clock.geo.w - 1))
+  if (term_clock.geo.y > (COLS - term_clock.geo.w - clock_sidebar() - 1))
     term_clock.geo.b = -1;
 
   clock_move(term_clock.geo.x + term_clock.geo.a, term_clock.geo.y + term_clock.geo.b,
@@ -334,53 +655,114 @@ void clock_rebound(void) {
 }
 
 void set_second(void) {
-  int new_w =
-      (((term_clock.option.second = !term_clock.option.second)) ? SECFRAMEW
-                                                            : NORMFRAMEW);
+  int new_w, new_h;
   int y_adj;
 
-  for (y_adj = 0; (term_clock.geo.y - y_adj) > (COLS - new_w - 1); ++y_adj)
+  term_clock.ctx.option.second = !term_clock.ctx.option.second;
+  clock_size(&new_w, &new_h);
+
+  for (y_adj = 0;
+       (term_clock.geo.y - y_adj) > (COLS - new_w - clock_sidebar() - 1);
+       ++y_adj)
     ;
 
-  clock_move(term_clock.geo.x, (term_clock.geo.y - y_adj), new_w, term_clock.geo.h);
+  clock_move(term_clock.geo.x, (term_clock.geo.y - y_adj), new_w, new_h);
 
   set_center(term_clock.option.center);
 
   return;
 }
 
+/* Centered frame position, keeping the date window and the calendar
+ * on screen too */
+void clock_center(int *x, int *y) {
+  *x = LINES / 2 - (term_clock.geo.h / 2);
+  if (*x > LINES - term_clock.geo.h - clock_overhang())
+    *x = LINES - term_clock.geo.h - clock_overhang();
+  *y = COLS / 2 - (term_clock.geo.w / 2);
+  if (*y > COLS - term_clock.geo.w - clock_sidebar())
+    *y = COLS - term_clock.geo.w - clock_sidebar();
+
+  if (*x < 0)
+    *x = 0;
+  if (*y < 0)
+    *y = 0;
+
+  return;
+}
+
 void set_center(bool b) {
+  int x, y;
+
   if ((term_clock.option.center = b)) {
     term_clock.option.rebound = false;
-
-    clock_move((LINES / 2 - (term_clock.geo.h / 2)),
-               (COLS / 2 - (term_clock.geo.w / 2)), term_clock.geo.w,
-               term_clock.geo.h);
+    clock_center(&x, &y);
+    clock_move(x, y, term_clock.geo.w, term_clock.geo.h);
   }
 
   return;
 }
 
+void set_analog(bool b) {
+  int new_w, new_h;
+  int x = term_clock.geo.x, y = term_clock.geo.y;
+
+  term_clock.option.analog = b;
+  clock_size(&new_w, &new_h);
+
+  /* Keep the whole frame on screen */
+  if (x > LINES - new_h - clock_overhang())
+    x = LINES - new_h - clock_overhang();
+  if (y > COLS - new_w - clock_sidebar())
+    y = COLS - new_w - clock_sidebar();
+
+  clock_move((x < 0) ? 0 : x, (y < 0) ? 0 : y, new_w, new_h);
+
+  set_center(term_clock.option.center);
+
+  return;
+}
+
 void set_box(bool b) {
   term_clock.option.box = b;
 
   wbkgdset(term_clock.framewin, COLOR_PAIR(0));
-  wbkgdset(term_clock.datewin, COLOR_PAIR(0));
 
   if (term_clock.option.box) {
-    wbkgdset(term_clock.framewin, COLOR_PAIR(0));
-    wbkgdset(term_clock.datewin, COLOR_PAIR(0));
     box(term_clock.framewin, 0, 0);
-    box(term_clock.datewin, 0, 0);
   } else {
     wborder(term_clock.framewin, ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ');
-    wborder(term_clock.datewin, ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ');
   }
 
-  wrefresh(term_clock.datewin);
+  if (term_clock.datewin) {
+    wbkgdset(term_clock.datewin, COLOR_PAIR(0));
+    if (term_clock.option.box)
+      box(term_clock.datewin, 0, 0);
+    else
+      wborder(term_clock.datewin, ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ');
+    wrefresh(term_clock.datewin);
+  }
+
+  if (term_clock.calwin && !term_clock.cal_hidden) {
+    wbkgdset(term_clock.calwin, COLOR_PAIR(0));
+    if (term_clock.option.box)
+      box(term_clock.calwin, 0, 0);
+    else
+      wborder(term_clock.calwin, ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ');
+    wrefresh(term_clock.calwin);
+  }
+
   wrefresh(term_clock.framewin);
 }
 
+void set_color(unsigned int color) {
+  term_clock.ctx.theme.from = color;
+  if (term_clock.ctx.theme.gradient == TERMCLOCK_GRADIENT_NONE)
+    term_clock.ctx.theme.to = color;
+  term_clock.dial_force = true;
+  term_clock.cal_force = true;
+}
+
 void key_event(void) {
   int i, c;
 
@@ -397,11 +779,8 @@ void key_event(void) {
     } else {
       nanosleep(&length, NULL);
       for (i = 0; i < 8; ++i)
-        if (c == (i + '0')) {
-          term_clock.option.color = i;
-          init_pair(1, term_clock.bg, i);
-          init_pair(2, i, term_clock.bg);
-        }
+        if (c == (i + '0'))
+          set_color(i);
     }
     return;
   }
@@ -440,7 +819,7 @@ void key_event(void) {
   case KEY_RIGHT:
   case 'l':
   case 'L':
-    if (term_clock.geo.y <= (COLS - term_clock.geo.w - 1) &&
+    if (term_clock.geo.y <= (COLS - term_clock.geo.w - clock_sidebar() - 1) &&
         !term_clock.option.center)
       clock_move(term_clock.geo.x, term_clock.geo.y + 1, term_clock.geo.w,
                  term_clock.geo.h);
@@ -459,8 +838,8 @@ void key_event(void) {
 
   case 't':
   case 'T':
-    term_clock.option.twelve = !term_clock.option.twelve;
-    /* Set the new term_clock.date.datestr to resize date window */
+    term_clock.ctx.option.twelve = !term_clock.ctx.option.twelve;
+    /* Set the new term_clock.ctx.date.datestr to resize date window */
     update_hour();
     clock_move(term_clock.geo.x, term_clock.geo.y, term_clock.geo.w, term_clock.geo.h);
     break;
@@ -470,9 +849,15 @@ void key_event(void) {
     set_center(!term_clock.option.center);
     break;
 
+  case 'a':
+  case 'A':
+    set_analog(!term_clock.option.analog);
+    break;
+
   case 'b':
   case 'B':
     term_clock.option.bold = !term_clock.option.bold;
+    term_clock.dial_force = true;
     break;
 
   case 'r':
@@ -495,10 +880,7 @@ void key_event(void) {
   case '5':
   case '6':
   case '7':
-    i = c - '0';
-    term_clock.option.color = i;
-    init_pair(1, term_clock.bg, i);
-    init_pair(2, i, term_clock.bg);
+    set_color(c - '0');
     break;
 
   default:
@@ -510,39 +892,46 @@ void key_event(void) {
 
 int main(int argc, char **argv) {
   int c;
+  bool gradient_to = false;
+  static const struct option long_options[] = {
+      {"startup-trace", no_argument, NULL, TRACEOPT},
+      {NULL, 0, NULL, 0},
+  };
 
   /* Alloc term_clock */
   memset(&term_clock, 0, sizeof(struct TermClock));
+  clock_gettime(CLOCK_MONOTONIC, &term_clock.trace.last);
+  termclock_init(&term_clock.ctx);
 
   term_clock.option.date = true;
 
-  /* Default date format */
-  strncpy(term_clock.option.format, "%F", sizeof(term_clock.option.format));
-  /* Default color */
-  term_clock.option.color = COLOR_GREEN; /* COLOR_GREEN = 2 */
   /* Default delay */
   term_clock.option.delay = 1;   /* 1FPS */
   term_clock.option.nsdelay = 0; /* -0FPS */
-  term_clock.option.blink = false;
 
   atexit(cleanup);
 
-  while ((c = getopt(argc, argv, "iuvsScbtrhBxnDC:f:d:T:a:")) != -1) {
+  while ((c = getopt_long(argc, argv, "iuvsScbtrhBxnADmC:f:d:T:a:g:G:P:",
+                          long_options, NULL)) != -1) {
     switch (c) {
     case 'h':
     default:
       printf(
-          "Usage: term-clock [-iuvsScbtrahDBxn] [-C [0-7]] [-f format] [-d "
-          "delay] [-a nsdelay] [-T term] \n"
+          "Usage: term-clock [-iuvsScbtrahDBxnAm] [-C color] [-g color] [-G "
+          "row|digit] [-f format] [-d delay] [-a nsdelay] [-T term] [-P name] \n"
           "    -s            Show seconds                                   \n"
           "    -S            Screensaver mode                               \n"
+          "    -A            Show an analog clock face                      \n"
           "    -x            Show box                                       \n"
           "    -c            Set the clock at the center of the terminal    \n"
-          "    -C [0-7]      Set the clock color                            \n"
+          "    -C color      Set the clock color ([0-255] or #rrggbb)       \n"
+          "    -g color      Blend the clock color into this one            \n"
+          "    -G row|digit  Blend per row (default) or per digit           \n"
           "    -b            Use bold colors                                \n"
           "    -t            Set the hour in 12h format                     \n"
           "    -u            Use UTC time                                   \n"
           "    -T term       Display the clock on the specified terminal    \n"
+          "    -P name       Publish the time to shared memory object name  \n"
           "    -r            Do rebound the clock                           \n"
           "    -f format     Set the date format                            \n"
           "    -n            Do not quit on keypress                         \n"
@@ -550,11 +939,14 @@ int main(int argc, char **argv) {
           "    -i            Show some info about term-clock                 \n"
           "    -h            Show this page                                 \n"
           "    -D            Hide date                                      \n"
+          "    -m            Show a month calendar next to the clock        \n"
           "    -B            Enable blinking colon                          \n"
           "    -d delay      Set the delay between two redraws of the clock. "
           "Default 1s. \n"
           "    -a nsdelay    Additional delay between two redraws in "
-          "nanoseconds. Default 0ns.\n");
+          "nanoseconds. Default 0ns.\n"
+          "    --startup-trace  Print the time spent in each startup phase "
+          "on exit\n");
       exit(EXIT_SUCCESS);
       break;
     case 'i':
@@ -562,18 +954,21 @@ int main(int argc, char **argv) {
       exit(EXIT_SUCCESS);
       break;
     case 'u':
-      term_clock.option.utc = true;
+      term_clock.ctx.option.utc = true;
       break;
     case 'v':
       puts("Term-Clock 20231105");
       exit(EXIT_SUCCESS);
       break;
     case 's':
-      term_clock.option.second = true;
+      term_clock.ctx.option.second = true;
       break;
     case 'S':
       term_clock.option.screensaver = true;
       break;
+    case 'A':
+      term_clock.option.analog = true;
+      break;
     case 'c':
       term_clock.option.center = true;
       break;
@@ -581,17 +976,30 @@ int main(int argc, char **argv) {
       term_clock.option.bold = true;
       break;
     case 'C':
-      if (atoi(optarg) >= 0 && atoi(optarg) < 8)
-        term_clock.option.color = atoi(optarg);
+      termclock_parse_color(optarg, &term_clock.ctx.theme.from);
+      break;
+    case 'g':
+      if (termclock_parse_color(optarg, &term_clock.ctx.theme.to) == 0) {
+        gradient_to = true;
+        if (term_clock.ctx.theme.gradient == TERMCLOCK_GRADIENT_NONE)
+          term_clock.ctx.theme.gradient = TERMCLOCK_GRADIENT_ROW;
+      }
+      break;
+    case 'G':
+      if (strcmp(optarg, "row") == 0)
+        term_clock.ctx.theme.gradient = TERMCLOCK_GRADIENT_ROW;
+      else if (strcmp(optarg, "digit") == 0)
+        term_clock.ctx.theme.gradient = TERMCLOCK_GRADIENT_DIGIT;
       break;
     case 't':
-      term_clock.option.twelve = true;
+      term_clock.ctx.option.twelve = true;
       break;
     case 'r':
       term_clock.option.rebound = true;
       break;
     case 'f':
-      strncpy(term_clock.option.format, optarg, 100);
+      snprintf(term_clock.ctx.option.format, sizeof(term_clock.ctx.option.format),
+               "%s", optarg);
       break;
     case 'd':
       if (atol(optarg) >= 0 && atol(optarg) < 100)
@@ -600,8 +1008,11 @@ int main(int argc, char **argv) {
     case 'D':
       term_clock.option.date = false;
       break;
+    case 'm':
+      term_clock.option.calendar = true;
+      break;
     case 'B':
-      term_clock.option.blink = true;
+      term_clock.ctx.option.blink = true;
       break;
     case 'a':
       if (atol(optarg) >= 0 && atol(optarg) < 1000000000)
@@ -630,10 +1041,30 @@ int main(int argc, char **argv) {
     case 'n':
       term_clock.option.noquit = true;
       break;
+    case 'P':
+      free(term_clock.shmname);
+      term_clock.shmname = strdup(optarg);
+      break;
+    case TRACEOPT:
+      term_clock.trace.enabled = true;
+      break;
     }
   }
 
+  /* Without -g, whatever the option order, there is no gradient to show */
+  if (!gradient_to)
+    term_clock.ctx.theme.to = term_clock.ctx.theme.from;
+  trace_phase("options");
+
+  if (term_clock.shmname &&
+      !(term_clock.shm = termclock_shm_create(term_clock.shmname))) {
+    fprintf(stderr, "term-clock: error: couldn't publish to '%s': %s.\n",
+            term_clock.shmname, strerror(errno));
+    exit(EXIT_FAILURE);
+  }
+
   init();
+  term_clock.trace.done = true;
   attron(A_BLINK);
   while (term_clock.running) {
     clock_rebound();
@@ -643,6 +1074,7 @@ int main(int argc, char **argv) {
   }
 
   endwin();
+  trace_print();
 
   return 0;
 }
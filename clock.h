@@ -44,18 +44,22 @@
 #include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <sys/select.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <time.h>
 #include <unistd.h>
 
+#include "libtermclock.h"
+
 /* Macro */
 #define NORMFRAMEW 35
 #define SECFRAMEW 54
 #define DATEWINH 3
-#define AMSIGN " [AM]"
-#define PMSIGN " [PM]"
+#define PAIRCACHEMAX 255
+#define TRACEMAX 16
+#define TRACEOPT 256
 
 /* Global TermClock struct */
 struct TermClock {
@@ -67,22 +71,23 @@ struct TermClock {
   char *term;
   int bg;
 
+  /* Shared memory time publisher (see termclock_shm_publish()) */
+  char *shmname;
+  struct TermClockShm *shm;
+  unsigned long long frame;
+
   /* Running option */
   struct {
-    bool second;
     bool screensaver;
-    bool twelve;
+    bool analog;
     bool center;
     bool rebound;
     bool date;
-    bool utc;
+    bool calendar;
     bool box;
     bool noquit;
-    char format[100];
-    int color;
     bool bold;
     long delay;
-    bool blink;
     long nsdelay;
   } option;
 
@@ -93,49 +98,85 @@ struct TermClock {
     int a, b;
   } geo;
 
-  /* Date content ([2] = number by number) */
+  /* Clock state and rendered digits (see libtermclock.h) */
+  struct TermClockCtx ctx;
+  struct TermClockCell cells[TERMCLOCK_DIGITH * TERMCLOCK_SECW];
+
+  /* Color pair cache (see pair_get()) */
   struct {
-    unsigned int hour[2];
-    unsigned int minute[2];
-    unsigned int second[2];
-    char datestr[256];
-    char old_datestr[256];
-  } date;
+    struct {
+      int fg, bg;
+      unsigned long used;
+    } pair[PAIRCACHEMAX];
+    int size;
+    int count;
+    unsigned long clock;
+  } pairs;
 
-  /* time.h utils */
-  struct tm *tm;
-  time_t lt;
+  /* Analog dial tables, the size they were built for, the hand
+   * positions currently on screen (-1 = none) and the cells touched by
+   * the last draw (see draw_dial()) */
+  struct TermClockDial dial;
+  int dial_lines, dial_cols;
+  int dialpos[3];
+  bool dial_force;
+  unsigned short dialmask[(2 * TERMCLOCK_DIALMAXR + 1) *
+                          (4 * TERMCLOCK_DIALMAXR + 1)];
+  unsigned short dialstamp;
+
+  /* Startup trace (see trace_phase()) */
+  struct {
+    bool enabled;
+    bool done;
+    struct timespec last;
+    int count;
+    struct {
+      const char *name;
+      long ns;
+    } phase[TRACEMAX];
+  } trace;
+
+  /* LC_TIME set up (see locale_init()) */
+  bool locale;
+
+  /* Month calendar, hidden while it does not fit, and drawn whole again
+   * on the next frame when forced (see draw_calendar()) */
+  struct TermClockCal cal;
+  bool cal_hidden;
+  bool cal_force;
 
   /* Clock member */
-  char *meridiem;
   WINDOW *framewin;
   WINDOW *datewin;
+  WINDOW *calwin;
 };
 
 /* Prototypes */
 void init(void);
+void locale_init(void);
+void date_init(void);
+void calendar_init(void);
+void trace_phase(const char *name);
+void trace_print(void);
 void signal_handler(int signal);
 void update_hour(void);
-void draw_number(int n, int x, int y);
+int term_color(unsigned int color);
+int pair_get(int fg, int bg);
+int cell_pair(const struct TermClockCell *cell);
+void draw_digits(void);
+void draw_dial(void);
+void draw_calendar(bool full);
 void draw_clock(void);
+int clock_overhang(void);
+int clock_sidebar(void);
+void clock_size(int *w, int *h);
 void clock_move(int x, int y, int w, int h);
 void set_second(void);
+void clock_center(int *x, int *y);
 void set_center(bool b);
+void set_analog(bool b);
 void set_box(bool b);
+void set_color(unsigned int color);
 void key_event(void);
 
-/* Number matrix */
-const bool number[][15] = {
-    {1, 1, 1, 1, 0, 1, 1, 0, 1, 1, 0, 1, 1, 1, 1}, /* 0 */
-    {0, 0, 1, 0, 0, 1, 0, 0, 1, 0, 0, 1, 0, 0, 1}, /* 1 */
-    {1, 1, 1, 0, 0, 1, 1, 1, 1, 1, 0, 0, 1, 1, 1}, /* 2 */
-    {1, 1, 1, 0, 0, 1, 1, 1, 1, 0, 0, 1, 1, 1, 1}, /* 3 */
-    {1, 0, 1, 1, 0, 1, 1, 1, 1, 0, 0, 1, 0, 0, 1}, /* 4 */
-    {1, 1, 1, 1, 0, 0, 1, 1, 1, 0, 0, 1, 1, 1, 1}, /* 5 */
-    {1, 1, 1, 1, 0, 0, 1, 1, 1, 1, 0, 1, 1, 1, 1}, /* 6 */
-    {1, 1, 1, 0, 0, 1, 0, 0, 1, 0, 0, 1, 0, 0, 1}, /* 7 */
-    {1, 1, 1, 1, 0, 1, 1, 1, 1, 1, 0, 1, 1, 1, 1}, /* 8 */
-    {1, 1, 1, 1, 0, 1, 1, 1, 1, 0, 0, 1, 1, 1, 1}, /* 9 */
-};
-
 #endif /* TTYCLOCK_H_INCLUDED */
@@ -0,0 +1,787 @@
+/*
+ *      TERM-CLOCK library file.
+ *      Copyright © 2023-2026 term-clock contributors
+ *      Copyright © 2009-2018 tty-clock contributors
+ *      Copyright © 2008 Martin Duquesnoy <xorg62@gmail.com>
+ *      All rights reserved.
+ *
+ *      Redistribution and use in source and binary forms, with or without
+ *      modification, are permitted provided that the following conditions are
+ *      met:
+ *
+ *      * Redistributions of source code must retain the above copyright
+ *        notice, this list of conditions and the following disclaimer.
+ *      * Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following disclaimer
+ *        in the documentation and/or other materials provided with the
+ *        distribution.
+ *      * Neither the name of the  nor the names of its
+ *        contributors may be used to endorse or promote products derived from
+ *        this software without specific prior written permission.
+ *
+ *      THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *      "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *      LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *      A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *      OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *      SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *      LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *      DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *      THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *      (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *      OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* localtime_r(), shm_open() and friends, also under strict -std=c11 */
+#define _POSIX_C_SOURCE 200809L
+
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <wchar.h>
+
+#include "libtermclock.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+/* Number matrix */
+static const bool number[][15] = {
+    {1, 1, 1, 1, 0, 1, 1, 0, 1, 1, 0, 1, 1, 1, 1}, /* 0 */
+    {0, 0, 1, 0, 0, 1, 0, 0, 1, 0, 0, 1, 0, 0, 1}, /* 1 */
+    {1, 1, 1, 0, 0, 1, 1, 1, 1, 1, 0, 0, 1, 1, 1}, /* 2 */
+    {1, 1, 1, 0, 0, 1, 1, 1, 1, 0, 0, 1, 1, 1, 1}, /* 3 */
+    {1, 0, 1, 1, 0, 1, 1, 1, 1, 0, 0, 1, 0, 0, 1}, /* 4 */
+    {1, 1, 1, 1, 0, 0, 1, 1, 1, 0, 0, 1, 1, 1, 1}, /* 5 */
+    {1, 1, 1, 1, 0, 0, 1, 1, 1, 1, 0, 1, 1, 1, 1}, /* 6 */
+    {1, 1, 1, 0, 0, 1, 0, 0, 1, 0, 0, 1, 0, 0, 1}, /* 7 */
+    {1, 1, 1, 1, 0, 1, 1, 1, 1, 1, 0, 1, 1, 1, 1}, /* 8 */
+    {1, 1, 1, 1, 0, 1, 1, 1, 1, 0, 0, 1, 1, 1, 1}, /* 9 */
+};
+
+/* xterm values of the 16 base colors */
+static const unsigned int base_rgb[16] = {
+    0x000000, 0xcd0000, 0x00cd00, 0xcdcd00, 0x0000ee, 0xcd00cd,
+    0x00cdcd, 0xe5e5e5, 0x7f7f7f, 0xff0000, 0x00ff00, 0xffff00,
+    0x5c5cff, 0xff00ff, 0x00ffff, 0xffffff,
+};
+
+/* Levels of the 6x6x6 color cube (16-231) */
+static const unsigned char cube_level[6] = {0, 95, 135, 175, 215, 255};
+
+/* Hand lengths, in fractions of the dial radius minus the marks */
+static const double hand_length[3] = {0.55, 0.85, 1.0};
+
+void termclock_init(struct TermClockCtx *ctx) {
+  memset(ctx, 0, sizeof(struct TermClockCtx));
+
+  /* Default date format */
+  strncpy(ctx->option.format, "%F", sizeof(ctx->option.format));
+  ctx->meridiem = "";
+
+  /* Default color */
+  ctx->theme.from = ctx->theme.to = 2; /* COLOR_GREEN = 2 */
+  ctx->theme.gradient = TERMCLOCK_GRADIENT_NONE;
+
+  return;
+}
+
+void termclock_update(struct TermClockCtx *ctx, time_t lt) {
+  int ihour;
+
+  ctx->lt = lt;
+  if (ctx->option.utc)
+    gmtime_r(&(ctx->lt), &(ctx->tm));
+  else
+    localtime_r(&(ctx->lt), &(ctx->tm));
+
+  ihour = ctx->tm.tm_hour;
+
+  if (ctx->option.twelve)
+    ctx->meridiem = ((ihour >= 12) ? TERMCLOCK_PMSIGN : TERMCLOCK_AMSIGN);
+  else
+    ctx->meridiem = "";
+
+  /* Manage hour for twelve mode */
+  ihour = ((ctx->option.twelve && ihour > 12) ? (ihour - 12) : ihour);
+  ihour = ((ctx->option.twelve && !ihour) ? 12 : ihour);
+
+  /* Set hour */
+  ctx->date.hour[0] = ihour / 10;
+  ctx->date.hour[1] = ihour % 10;
+
+  /* Set minutes */
+  ctx->date.minute[0] = ctx->tm.tm_min / 10;
+  ctx->date.minute[1] = ctx->tm.tm_min % 10;
+
+  /* Set date string */
+  strcpy(ctx->date.old_datestr, ctx->date.datestr);
+  termclock_format_date(ctx);
+
+  /* Set seconds */
+  ctx->date.second[0] = ctx->tm.tm_sec / 10;
+  ctx->date.second[1] = ctx->tm.tm_sec % 10;
+
+  return;
+}
+
+/*
+ * Format datestr from the last update, leaving old_datestr alone. Useful
+ * after a locale change, which would otherwise look like a rollover.
+ */
+void termclock_format_date(struct TermClockCtx *ctx) {
+  char tmpstr[128];
+
+  /* tmpstr is unspecified when the date does not fit */
+  if (strftime(tmpstr, sizeof(tmpstr), ctx->option.format, &(ctx->tm)) == 0)
+    tmpstr[0] = '\0';
+  snprintf(ctx->date.datestr, sizeof(ctx->date.datestr), "%s%s", tmpstr,
+           ctx->meridiem);
+
+  return;
+}
+
+int termclock_width(const struct TermClockCtx *ctx) {
+  return (ctx->option.second) ? TERMCLOCK_SECW : TERMCLOCK_NORMW;
+}
+
+/*
+ * Parse a color given as a palette index (0-255) or as #rrggbb.
+ * Returns -1 and leaves *color untouched on malformed input.
+ */
+int termclock_parse_color(const char *str, unsigned int *color) {
+  int i;
+  unsigned long v;
+
+  if (str[0] == '#') {
+    /* Exactly six hex digits: no sign, space or 0x prefix */
+    for (i = 1; i < 7; ++i)
+      if (!isxdigit((unsigned char)str[i]))
+        return -1;
+    if (str[7] != '\0')
+      return -1;
+    v = strtoul(str + 1, NULL, 16);
+    *color = TERMCLOCK_RGBFLAG | (unsigned int)v;
+    return 0;
+  }
+
+  /* One to three decimal digits */
+  for (i = 0; str[i] != '\0'; ++i)
+    if (!isdigit((unsigned char)str[i]) || i == 3)
+      return -1;
+  if (i == 0)
+    return -1;
+  v = strtoul(str, NULL, 10);
+  if (v > 255)
+    return -1;
+  *color = (unsigned int)v;
+
+  return 0;
+}
+
+/* 0xrrggbb value of any color */
+unsigned int termclock_color_rgb(unsigned int color) {
+  unsigned int i;
+
+  if (TERMCLOCK_ISRGB(color))
+    return color & 0xffffff;
+
+  if (color < 16)
+    return base_rgb[color];
+
+  if (color < 232) {
+    i = color - 16;
+    return (cube_level[i / 36] << 16) | (cube_level[(i / 6) % 6] << 8) |
+           cube_level[i % 6];
+  }
+
+  i = 8 + (color - 232) * 10;
+  return (i << 16) | (i << 8) | i;
+}
+
+static unsigned int rgb_distance(unsigned int a, unsigned int b) {
+  int dr = (int)(a >> 16) - (int)(b >> 16);
+  int dg = (int)((a >> 8) & 0xff) - (int)((b >> 8) & 0xff);
+  int db = (int)(a & 0xff) - (int)(b & 0xff);
+
+  return dr * dr + dg * dg + db * db;
+}
+
+static int cube_nearest(unsigned int v) {
+  int i;
+
+  for (i = 0; i < 5 && v > (cube_level[i] + cube_level[i + 1]) / 2u; ++i)
+    ;
+
+  return i;
+}
+
+/*
+ * Nearest palette index of a color on a terminal with ncolors colors.
+ * Palette colors the terminal has are returned as is.
+ */
+unsigned int termclock_color_index(unsigned int color, int ncolors) {
+  unsigned int rgb, best, d, bestd;
+  int i, r, g, b, gray;
+
+  if (!TERMCLOCK_ISRGB(color) && (int)color < ncolors)
+    return color;
+
+  rgb = termclock_color_rgb(color);
+
+  if (ncolors >= 256) {
+    /* Closest of the cube and of the gray ramp */
+    r = cube_nearest(rgb >> 16);
+    g = cube_nearest((rgb >> 8) & 0xff);
+    b = cube_nearest(rgb & 0xff);
+    best = 16 + r * 36 + g * 6 + b;
+
+    gray = (int)(((rgb >> 16) + ((rgb >> 8) & 0xff) + (rgb & 0xff)) / 3);
+    gray = (gray < 8) ? 0 : (gray - 8 + 5) / 10;
+    gray = 232 + ((gray > 23) ? 23 : gray);
+
+    if (rgb_distance(rgb, termclock_color_rgb(gray)) <
+        rgb_distance(rgb, termclock_color_rgb(best)))
+      best = gray;
+    return best;
+  }
+
+  if (ncolors > 16)
+    ncolors = 16;
+
+  best = 0;
+  bestd = ~0u;
+  for (i = 0; i < ncolors; ++i) {
+    if ((d = rgb_distance(rgb, base_rgb[i])) < bestd) {
+      bestd = d;
+      best = i;
+    }
+  }
+
+  return best;
+}
+
+/* Color at position n of steps along the theme gradient */
+static unsigned int theme_color(const struct TermClockTheme *theme, int n,
+                                int steps) {
+  unsigned int a, b, c = 0;
+  int shift, ca, cb;
+
+  if (theme->gradient == TERMCLOCK_GRADIENT_NONE || theme->from == theme->to ||
+      steps < 2)
+    return theme->from;
+
+  a = termclock_color_rgb(theme->from);
+  b = termclock_color_rgb(theme->to);
+
+  for (shift = 0; shift <= 16; shift += 8) {
+    ca = (a >> shift) & 0xff;
+    cb = (b >> shift) & 0xff;
+    c |= (unsigned int)(ca + (cb - ca) * n / (steps - 1)) << shift;
+  }
+
+  return TERMCLOCK_RGBFLAG | c;
+}
+
+static void render_number(struct TermClockCell *cells, int w, int n, int y,
+                          const unsigned int *colors, unsigned int color) {
+  int i;
+  struct TermClockCell *cell;
+
+  for (i = 0; i < 30; ++i) {
+    cell = &cells[(i / 6) * w + y + (i % 6)];
+    cell->lit = number[n][i / 2];
+    cell->color = colors ? colors[i / 6] : color;
+  }
+
+  return;
+}
+
+static void render_dots(struct TermClockCell *cells, int w, int y, bool lit,
+                        const unsigned int *colors, unsigned int color) {
+  int i, r;
+
+  for (i = 0; i < 4; ++i) {
+    r = (i < 2) ? 1 : 3;
+    cells[r * w + y + i % 2].lit = lit;
+    cells[r * w + y + i % 2].color = colors ? colors[r] : color;
+  }
+
+  return;
+}
+
+/*
+ * Render the digit area of the clock (TERMCLOCK_DIGITH rows of
+ * termclock_width() cells) into a row-major buffer of w * h cells.
+ * Returns -1 and leaves the buffer untouched when it is too small.
+ */
+int termclock_render(const struct TermClockCtx *ctx, struct TermClockCell *cells,
+                     int w, int h) {
+  int i, glyphs;
+  unsigned int rows[TERMCLOCK_DIGITH], g[8];
+  const unsigned int *rowcolors = NULL;
+  bool dot = !(ctx->option.blink && ctx->lt % 2 == 0);
+
+  if (w < termclock_width(ctx) || h < TERMCLOCK_DIGITH)
+    return -1;
+
+  for (i = 0; i < w * h; ++i) {
+    cells[i].ch = ' ';
+    cells[i].lit = false;
+    cells[i].color = ctx->theme.from;
+  }
+
+  /* One color per row, or per glyph (numbers and dots) */
+  glyphs = (ctx->option.second) ? 8 : 5;
+  for (i = 0; i < glyphs; ++i)
+    g[i] = (ctx->theme.gradient == TERMCLOCK_GRADIENT_DIGIT)
+               ? theme_color(&(ctx->theme), i, glyphs)
+               : ctx->theme.from;
+  if (ctx->theme.gradient == TERMCLOCK_GRADIENT_ROW) {
+    for (i = 0; i < TERMCLOCK_DIGITH; ++i)
+      rows[i] = theme_color(&(ctx->theme), i, TERMCLOCK_DIGITH);
+    rowcolors = rows;
+  }
+
+  /* Hour numbers, 2 dot for number separation, minute numbers */
+  render_number(cells, w, ctx->date.hour[0], 0, rowcolors, g[0]);
+  render_number(cells, w, ctx->date.hour[1], 7, rowcolors, g[1]);
+  render_dots(cells, w, 15, dot, rowcolors, g[2]);
+  render_number(cells, w, ctx->date.minute[0], 19, rowcolors, g[3]);
+  render_number(cells, w, ctx->date.minute[1], 26, rowcolors, g[4]);
+
+  /* Again 2 dot and second numbers if the option is enabled */
+  if (ctx->option.second) {
+    render_dots(cells, w, 34, dot, rowcolors, g[5]);
+    render_number(cells, w, ctx->date.second[0], 38, rowcolors, g[6]);
+    render_number(cells, w, ctx->date.second[1], 45, rowcolors, g[7]);
+  }
+
+  return 0;
+}
+
+/* Bresenham line from (r0, c0) to (r1, c1), returns the number of cells */
+static int dial_line(struct TermClockPoint *out, int r0, int c0, int r1,
+                     int c1) {
+  int n = 0, e2;
+  int dr = -abs(r1 - r0), sr = (r0 < r1) ? 1 : -1;
+  int dc = abs(c1 - c0), sc = (c0 < c1) ? 1 : -1;
+  int err = dc + dr;
+
+  for (;;) {
+    out[n].row = r0;
+    out[n].col = c0;
+    ++n;
+    if (r0 == r1 && c0 == c1)
+      break;
+    e2 = 2 * err;
+    if (e2 >= dr) {
+      err += dr;
+      c0 += sc;
+    }
+    if (e2 <= dc) {
+      err += dc;
+      r0 += sr;
+    }
+  }
+
+  return n;
+}
+
+/*
+ * Build the dial tables for the largest dial fitting in w * h cells.
+ * Cells are about twice as high as wide, so the dial is 2r + 1 rows by
+ * 4r + 1 columns. Returns -1 when not even a tiny dial fits.
+ */
+int termclock_dial_build(struct TermClockDial *dial, int w, int h) {
+  int r, hand, pos, n = 0;
+  double a, len;
+
+  r = (h - 1) / 2;
+  if ((w - 1) / 4 < r)
+    r = (w - 1) / 4;
+  if (r > TERMCLOCK_DIALMAXR)
+    r = TERMCLOCK_DIALMAXR;
+  if (r < 3)
+    return -1;
+
+  dial->radius = r;
+  dial->h = 2 * r + 1;
+  dial->w = 4 * r + 1;
+
+  for (hand = 0; hand < 3; ++hand) {
+    len = (r - 1) * hand_length[hand];
+    for (pos = 0; pos < 60; ++pos) {
+      a = pos * M_PI / 30;
+      dial->start[hand * 60 + pos] = n;
+      n += dial_line(&(dial->cells[n]), r, 2 * r, lround(r - cos(a) * len),
+                     lround(2 * r + sin(a) * len * 2));
+    }
+  }
+  dial->start[3 * 60] = n;
+
+  for (pos = 0; pos < 12; ++pos) {
+    a = pos * M_PI / 6;
+    dial->marks[pos].row = lround(r - cos(a) * r);
+    dial->marks[pos].col = lround(2 * r + sin(a) * r * 2);
+  }
+
+  return 0;
+}
+
+/* Current position (0-59) of a hand */
+int termclock_dial_pos(const struct TermClockCtx *ctx, enum TermClockHand hand) {
+  switch (hand) {
+  case TERMCLOCK_HAND_HOUR:
+    return (ctx->tm.tm_hour % 12) * 5 + ctx->tm.tm_min / 12;
+  case TERMCLOCK_HAND_MINUTE:
+    return ctx->tm.tm_min;
+  case TERMCLOCK_HAND_SECOND:
+    return ctx->tm.tm_sec % 60;
+  default:
+    return 0;
+  }
+}
+
+/* Cells of a hand at pos, or the 12 hour marks */
+const struct TermClockPoint *termclock_dial_hand(const struct TermClockDial *dial,
+                                                 enum TermClockHand hand,
+                                                 int pos, int *n) {
+  if (hand == TERMCLOCK_HAND_MARK) {
+    *n = 12;
+    return dial->marks;
+  }
+
+  *n = dial->start[hand * 60 + pos + 1] - dial->start[hand * 60 + pos];
+
+  return &(dial->cells[dial->start[hand * 60 + pos]]);
+}
+
+/* How a cell of a hand (or mark) is drawn */
+struct TermClockCell termclock_dial_cell(const struct TermClockCtx *ctx,
+                                         const struct TermClockDial *dial,
+                                         enum TermClockHand hand,
+                                         struct TermClockPoint p) {
+  struct TermClockCell cell = {' ', true, ctx->theme.from};
+
+  if (ctx->theme.gradient == TERMCLOCK_GRADIENT_ROW)
+    cell.color = theme_color(&(ctx->theme), p.row, dial->h);
+  else if (ctx->theme.gradient == TERMCLOCK_GRADIENT_DIGIT &&
+           hand != TERMCLOCK_HAND_MARK)
+    cell.color = theme_color(&(ctx->theme), hand, 3);
+
+  /* The second hand is a thin dotted line */
+  if (hand == TERMCLOCK_HAND_SECOND) {
+    cell.ch = '.';
+    cell.lit = false;
+  }
+
+  return cell;
+}
+
+/*
+ * Render the whole analog dial (dial->h rows of dial->w cells) into a
+ * row-major buffer of w * h cells. Returns -1 when it is too small.
+ */
+int termclock_dial_render(const struct TermClockCtx *ctx,
+                          const struct TermClockDial *dial,
+                          struct TermClockCell *cells, int w, int h) {
+  int i, n, hand;
+  const struct TermClockPoint *p;
+
+  if (w < dial->w || h < dial->h)
+    return -1;
+
+  for (i = 0; i < w * h; ++i) {
+    cells[i].ch = ' ';
+    cells[i].lit = false;
+    cells[i].color = ctx->theme.from;
+  }
+
+  for (hand = TERMCLOCK_HAND_MARK; hand >= TERMCLOCK_HAND_HOUR; --hand) {
+    if (hand == TERMCLOCK_HAND_SECOND && !ctx->option.second)
+      continue;
+    p = termclock_dial_hand(dial, hand, termclock_dial_pos(ctx, hand), &n);
+    for (i = 0; i < n; ++i)
+      cells[p[i].row * w + p[i].col] =
+          termclock_dial_cell(ctx, dial, hand, p[i]);
+  }
+
+  return 0;
+}
+
+static int month_days(int year, int mon) {
+  static const int days[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+
+  year += 1900;
+  if (mon == 1 && ((year % 4 == 0 && year % 100 != 0) || year % 400 == 0))
+    return 29;
+
+  return days[mon];
+}
+
+/* Build the month grid of tm, with tm's day as today */
+void termclock_cal_build(struct TermClockCal *cal, const struct tm *tm) {
+  int i, d, pad;
+  size_t cols, n;
+  char title[40], *line;
+  struct tm wday = *tm;
+  mbstate_t ps;
+
+  cal->year = tm->tm_year;
+  cal->mon = tm->tm_mon;
+  cal->mday = tm->tm_mday;
+  cal->first = (tm->tm_wday - (tm->tm_mday - 1) % 7 + 7) % 7;
+  cal->days = month_days(tm->tm_year, tm->tm_mon);
+
+  /* Month name and year, centered */
+  if (strftime(title, sizeof(title), "%B %Y", tm) == 0)
+    title[0] = '\0';
+  /* Center on columns, not bytes, for multibyte month names */
+  if ((cols = mbstowcs(NULL, title, 0)) == (size_t)-1)
+    cols = strlen(title);
+  pad = (cols < TERMCLOCK_CALW) ? (TERMCLOCK_CALW - cols) / 2 : 0;
+  memset(cal->lines[0], ' ', pad);
+  strcpy(cal->lines[0] + pad, title);
+
+  /* Week days in the same locale, cut or padded to 2 columns */
+  line = cal->lines[1];
+  for (wday.tm_wday = 0; wday.tm_wday < 7; ++wday.tm_wday) {
+    if (strftime(title, sizeof(title), "%a", &wday) == 0)
+      title[0] = '\0';
+    memset(&ps, 0, sizeof(ps));
+    for (i = 0, cols = 0; title[i] != '\0' && cols < 2; i += n, ++cols) {
+      n = mbrlen(title + i, MB_CUR_MAX, &ps);
+      if (n == 0 || n == (size_t)-1 || n == (size_t)-2) {
+        memset(&ps, 0, sizeof(ps));
+        n = 1;
+      }
+    }
+    memcpy(line, title, i);
+    line += i;
+    for (; cols < 2; ++cols)
+      *line++ = ' ';
+    if (wday.tm_wday < 6)
+      *line++ = ' ';
+  }
+  *line = '\0';
+
+  for (i = 2; i < TERMCLOCK_CALH; ++i) {
+    memset(cal->lines[i], ' ', TERMCLOCK_CALW);
+    cal->lines[i][TERMCLOCK_CALW] = '\0';
+  }
+
+  for (d = 1; d <= cal->days; ++d) {
+    struct TermClockPoint p = termclock_cal_day(cal, d);
+    cal->lines[p.row][p.col] = (d < 10) ? ' ' : '0' + d / 10;
+    cal->lines[p.row][p.col + 1] = '0' + d % 10;
+  }
+
+  return;
+}
+
+/* Line and column of the two characters of a day in the grid */
+struct TermClockPoint termclock_cal_day(const struct TermClockCal *cal, int mday) {
+  struct TermClockPoint p;
+
+  p.row = 2 + (cal->first + mday - 1) / 7;
+  p.col = 3 * ((cal->first + mday - 1) % 7);
+
+  return p;
+}
+
+/* Map an open shared memory object, NULL with errno set on failure */
+static struct TermClockShm *shm_map(int fd, int prot) {
+  struct stat st;
+  struct TermClockShm *shm;
+
+  /* Mapping past the end of a smaller object would SIGBUS on access */
+  if (fstat(fd, &st) == -1)
+    return NULL;
+  if (st.st_size < (off_t)sizeof(struct TermClockShm)) {
+    errno = EPROTO;
+    return NULL;
+  }
+
+  shm = mmap(NULL, sizeof(struct TermClockShm), prot, MAP_SHARED, fd, 0);
+  if (shm == MAP_FAILED)
+    return NULL;
+
+  if (shm->magic != TERMCLOCK_SHMMAGIC ||
+      shm->version != TERMCLOCK_SHMVERSION) {
+    munmap(shm, sizeof(struct TermClockShm));
+    errno = EPROTO;
+    return NULL;
+  }
+
+  return shm;
+}
+
+/*
+ * Take over the existing object name when its writer is gone (killed
+ * before it could remove it). Fails with EEXIST while the writer runs,
+ * or when the object is not a term-clock one.
+ */
+static struct TermClockShm *shm_reclaim(const char *name) {
+  int fd, pid;
+  struct TermClockShm *shm;
+
+  if ((fd = shm_open(name, O_RDWR, 0)) == -1)
+    return NULL;
+
+  shm = shm_map(fd, PROT_READ | PROT_WRITE);
+  close(fd);
+  if (shm == NULL) {
+    errno = EEXIST;
+    return NULL;
+  }
+
+  /* Only one of several new writers wins the exchange */
+  pid = atomic_load(&(shm->pid));
+  if (pid <= 0 || pid == getpid() || kill(pid, 0) == 0 || errno != ESRCH ||
+      !atomic_compare_exchange_strong(&(shm->pid), &pid, getpid())) {
+    munmap(shm, sizeof(struct TermClockShm));
+    errno = EEXIST;
+    return NULL;
+  }
+
+  /* The old writer may have died in an update: start over */
+  atomic_store(&(shm->seq), 0);
+  memset(&(shm->snap), 0, sizeof(struct TermClockSnapshot));
+
+  return shm;
+}
+
+/*
+ * Create the shared memory object name and map it for
+ * termclock_shm_publish(). There is only one writer: an object that
+ * another running term-clock publishes to fails with EEXIST, one left
+ * over by a dead writer is taken over. Returns NULL with errno set on
+ * failure.
+ */
+struct TermClockShm *termclock_shm_create(const char *name) {
+  int fd, err;
+  struct TermClockShm *shm;
+
+  if ((fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644)) == -1)
+    return (errno == EEXIST) ? shm_reclaim(name) : NULL;
+
+  if (ftruncate(fd, sizeof(struct TermClockShm)) == -1) {
+    err = errno;
+    close(fd);
+    shm_unlink(name);
+    errno = err;
+    return NULL;
+  }
+
+  shm = mmap(NULL, sizeof(struct TermClockShm), PROT_READ | PROT_WRITE,
+             MAP_SHARED, fd, 0);
+  close(fd);
+  if (shm == MAP_FAILED) {
+    err = errno;
+    shm_unlink(name);
+    errno = err;
+    return NULL;
+  }
+
+  /* Nothing published yet: seq 0 (see termclock_shm_read()) */
+  atomic_store(&(shm->seq), 0);
+  atomic_store(&(shm->pid), getpid());
+  memset(&(shm->snap), 0, sizeof(struct TermClockSnapshot));
+  shm->magic = TERMCLOCK_SHMMAGIC;
+  shm->version = TERMCLOCK_SHMVERSION;
+
+  return shm;
+}
+
+/* Map the shared memory object name read-only, NULL on failure */
+const struct TermClockShm *termclock_shm_open(const char *name) {
+  int fd;
+  const struct TermClockShm *shm;
+
+  if ((fd = shm_open(name, O_RDONLY, 0)) == -1)
+    return NULL;
+
+  shm = shm_map(fd, PROT_READ);
+  close(fd);
+
+  return shm;
+}
+
+void termclock_shm_close(const struct TermClockShm *shm) {
+  munmap((void *)shm, sizeof(struct TermClockShm));
+
+  return;
+}
+
+/* Publish the last update of ctx (single writer) */
+void termclock_shm_publish(struct TermClockShm *shm,
+                           const struct TermClockCtx *ctx,
+                           unsigned long long frame) {
+  unsigned int seq = atomic_load_explicit(&(shm->seq), memory_order_relaxed);
+  /* Skip 0 on wrap, it means nothing was published */
+  unsigned int next = (seq + 2 == 0) ? 2 : seq + 2;
+  struct TermClockSnapshot *snap = &(shm->snap);
+
+  atomic_store_explicit(&(shm->seq), seq + 1, memory_order_relaxed);
+  atomic_thread_fence(memory_order_release);
+
+  snap->epoch = ctx->lt;
+  snap->year = ctx->tm.tm_year + 1900;
+  snap->mon = ctx->tm.tm_mon + 1;
+  snap->mday = ctx->tm.tm_mday;
+  snap->hour = ctx->tm.tm_hour;
+  snap->min = ctx->tm.tm_min;
+  snap->sec = ctx->tm.tm_sec;
+  snap->wday = ctx->tm.tm_wday;
+  snap->yday = ctx->tm.tm_yday;
+  snap->isdst = ctx->tm.tm_isdst;
+  snap->frame = frame;
+  strcpy(snap->datestr, ctx->date.datestr);
+
+  atomic_store_explicit(&(shm->seq), next, memory_order_release);
+
+  return;
+}
+
+/*
+ * Copy a consistent snapshot, without locks nor syscalls. Returns -1 with
+ * errno set to ENODATA when nothing was published yet, or to EAGAIN when
+ * no consistent copy could be made (writer stuck in an update).
+ */
+int termclock_shm_read(const struct TermClockShm *shm,
+                       struct TermClockSnapshot *snap) {
+  int tries;
+  unsigned int seq;
+
+  for (tries = 0; tries < 10000; ++tries) {
+    seq = atomic_load_explicit((atomic_uint *)&(shm->seq), memory_order_acquire);
+    if (seq == 0) {
+      errno = ENODATA;
+      return -1;
+    }
+    if (seq & 1)
+      continue;
+
+    memcpy(snap, &(shm->snap), sizeof(struct TermClockSnapshot));
+    atomic_thread_fence(memory_order_acquire);
+
+    if (atomic_load_explicit((atomic_uint *)&(shm->seq),
+                             memory_order_relaxed) == seq) {
+      snap->datestr[sizeof(snap->datestr) - 1] = '\0';
+      return 0;
+    }
+  }
+
+  errno = EAGAIN;
+  return -1;
+}
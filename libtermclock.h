@@ -0,0 +1,212 @@
+/*
+ *      TERM-CLOCK library headers file.
+ *      Copyright © 2023-2026 term-clock contributors
+ *      Copyright © 2009-2013 tty-clock contributors
+ *      Copyright © 2008-2009 Martin Duquesnoy <xorg62@gmail.com>
+ *      All rights reserved.
+ *
+ *      Redistribution and use in source and binary forms, with or without
+ *      modification, are permitted provided that the following conditions are
+ *      met:
+ *
+ *      * Redistributions of source code must retain the above copyright
+ *        notice, this list of conditions and the following disclaimer.
+ *      * Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following disclaimer
+ *        in the documentation and/or other materials provided with the
+ *        distribution.
+ *      * Neither the name of the  nor the names of its
+ *        contributors may be used to endorse or promote products derived from
+ *        this software without specific prior written permission.
+ *
+ *      THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *      "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *      LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *      A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *      OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *      SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *      LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *      DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *      THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *      (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *      OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ *      libtermclock keeps all clock state in a caller-owned TermClockCtx and
+ *      renders frames into caller-owned cell buffers. It has no global state
+ *      and never allocates, so any number of clocks can live in one process
+ *      and be drawn by any front end (see clock.c for the ncurses one).
+ */
+
+#ifndef LIBTERMCLOCK_H_INCLUDED
+#define LIBTERMCLOCK_H_INCLUDED
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <time.h>
+
+/* Macro */
+#define TERMCLOCK_DIGITH 5
+#define TERMCLOCK_NORMW 33
+#define TERMCLOCK_SECW 52
+#define TERMCLOCK_AMSIGN " [AM]"
+#define TERMCLOCK_PMSIGN " [PM]"
+#define TERMCLOCK_DIALMAXR 48
+#define TERMCLOCK_CALW 20
+#define TERMCLOCK_CALH 8
+#define TERMCLOCK_SHMMAGIC 0x6b6c6374 /* "tclk" */
+#define TERMCLOCK_SHMVERSION 2
+
+/* Colors: 0-255 are palette indexes, TERMCLOCK_RGB() ones are 24-bit */
+#define TERMCLOCK_RGBFLAG 0x1000000u
+#define TERMCLOCK_RGB(r, g, b)                                                 \
+  (TERMCLOCK_RGBFLAG | ((unsigned int)(r) << 16) | ((unsigned int)(g) << 8) |  \
+   (unsigned int)(b))
+#define TERMCLOCK_ISRGB(c) (((c)&TERMCLOCK_RGBFLAG) != 0)
+
+enum TermClockGradient {
+  TERMCLOCK_GRADIENT_NONE,
+  TERMCLOCK_GRADIENT_DIGIT,
+  TERMCLOCK_GRADIENT_ROW,
+};
+
+/* Clock colors: 'from' alone, or blended into 'to' along the gradient */
+struct TermClockTheme {
+  unsigned int from;
+  unsigned int to;
+  enum TermClockGradient gradient;
+};
+
+/* One rendered cell: lit cells are painted with their color */
+struct TermClockCell {
+  char ch;
+  bool lit;
+  unsigned int color;
+};
+
+enum TermClockHand {
+  TERMCLOCK_HAND_HOUR,
+  TERMCLOCK_HAND_MINUTE,
+  TERMCLOCK_HAND_SECOND,
+  TERMCLOCK_HAND_MARK,
+};
+
+/* Cell position, relative to the top left corner of the dial */
+struct TermClockPoint {
+  unsigned char row;
+  unsigned char col;
+};
+
+/*
+ * Analog dial rasterization tables for one dial size, built once by
+ * termclock_dial_build(). The line of every hand at each of its 60
+ * positions is stored back to back in 'cells': hand h at position p spans
+ * cells[start[h * 60 + p]] up to cells[start[h * 60 + p + 1]].
+ */
+struct TermClockDial {
+  int w, h;
+  int radius;
+  unsigned short start[3 * 60 + 1];
+  struct TermClockPoint marks[12];
+  struct TermClockPoint cells[3 * 60 * (2 * TERMCLOCK_DIALMAXR + 1)];
+};
+
+/*
+ * Month calendar pre-rendered as text lines (title, week days, then up to
+ * six weeks) by termclock_cal_build(). 'mday' is the day shown as today.
+ */
+struct TermClockCal {
+  int year, mon, mday;
+  int first, days;
+  char lines[TERMCLOCK_CALH][64];
+};
+
+/* Time published to other processes (see termclock_shm_read()) */
+struct TermClockSnapshot {
+  long long epoch;
+  int year, mon, mday;
+  int hour, min, sec;
+  int wday, yday, isdst;
+  unsigned long long frame;
+  char datestr[256];
+};
+
+/*
+ * POSIX shared memory layout. The writer makes 'seq' odd while it updates
+ * the snapshot, so readers can copy it without locks nor syscalls and
+ * retry whenever 'seq' was odd or changed under them (a seqlock). 'seq'
+ * is 0 until the first update. 'pid' is the writer, so that the object
+ * can be taken over once it is gone.
+ */
+struct TermClockShm {
+  unsigned int magic;
+  unsigned int version;
+  atomic_int pid;
+  atomic_uint seq;
+  struct TermClockSnapshot snap;
+};
+
+/* Clock context, one per displayed clock */
+struct TermClockCtx {
+  /* Clock option */
+  struct {
+    bool second;
+    bool twelve;
+    bool utc;
+    bool blink;
+    char format[100];
+  } option;
+
+  struct TermClockTheme theme;
+
+  /* Date content ([2] = number by number) */
+  struct {
+    unsigned int hour[2];
+    unsigned int minute[2];
+    unsigned int second[2];
+    char datestr[256];
+    char old_datestr[256];
+  } date;
+
+  /* time.h utils */
+  struct tm tm;
+  time_t lt;
+
+  const char *meridiem;
+};
+
+/* Prototypes */
+void termclock_init(struct TermClockCtx *ctx);
+void termclock_update(struct TermClockCtx *ctx, time_t lt);
+void termclock_format_date(struct TermClockCtx *ctx);
+int termclock_width(const struct TermClockCtx *ctx);
+int termclock_render(const struct TermClockCtx *ctx, struct TermClockCell *cells,
+                     int w, int h);
+int termclock_parse_color(const char *str, unsigned int *color);
+unsigned int termclock_color_rgb(unsigned int color);
+unsigned int termclock_color_index(unsigned int color, int ncolors);
+int termclock_dial_build(struct TermClockDial *dial, int w, int h);
+int termclock_dial_pos(const struct TermClockCtx *ctx, enum TermClockHand hand);
+const struct TermClockPoint *termclock_dial_hand(const struct TermClockDial *dial,
+                                                 enum TermClockHand hand,
+                                                 int pos, int *n);
+struct TermClockCell termclock_dial_cell(const struct TermClockCtx *ctx,
+                                         const struct TermClockDial *dial,
+                                         enum TermClockHand hand,
+                                         struct TermClockPoint p);
+void termclock_cal_build(struct TermClockCal *cal, const struct tm *tm);
+struct TermClockPoint termclock_cal_day(const struct TermClockCal *cal, int mday);
+struct TermClockShm *termclock_shm_create(const char *name);
+const struct TermClockShm *termclock_shm_open(const char *name);
+void termclock_shm_close(const struct TermClockShm *shm);
+void termclock_shm_publish(struct TermClockShm *shm,
+                           const struct TermClockCtx *ctx,
+                           unsigned long long frame);
+int termclock_shm_read(const struct TermClockShm *shm,
+                       struct TermClockSnapshot *snap);
+int termclock_dial_render(const struct TermClockCtx *ctx,
+                          const struct TermClockDial *dial,
+                          struct TermClockCell *cells, int w, int h);
+
+#endif /* LIBTERMCLOCK_H_INCLUDED */
@@ -0,0 +1,97 @@
+/*
+ *      TERM-CLOCK shared memory reader.
+ *      Copyright © 2023-2026 term-clock contributors
+ *      Copyright © 2009-2018 tty-clock contributors
+ *      Copyright © 2008 Martin Duquesnoy <xorg62@gmail.com>
+ *      All rights reserved.
+ *
+ *      Redistribution and use in source and binary forms, with or without
+ *      modification, are permitted provided that the following conditions are
+ *      met:
+ *
+ *      * Redistributions of source code must retain the above copyright
+ *        notice, this list of conditions and the following disclaimer.
+ *      * Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following disclaimer
+ *        in the documentation and/or other materials provided with the
+ *        distribution.
+ *      * Neither the name of the  nor the names of its
+ *        contributors may be used to endorse or promote products derived from
+ *        this software without specific prior written permission.
+ *
+ *      THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *      "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *      LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *      A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *      OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *      SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *      LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *      DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *      THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *      (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *      OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "libtermclock.h"
+
+int main(int argc, char **argv) {
+  int c;
+  bool epoch = false, all = false;
+  const struct TermClockShm *shm;
+  struct TermClockSnapshot snap;
+
+  while ((c = getopt(argc, argv, "eah")) != -1) {
+    switch (c) {
+    case 'e':
+      epoch = true;
+      break;
+    case 'a':
+      all = true;
+      break;
+    case 'h':
+    default:
+      printf("Usage: term-clock-read [-eah] name\n"
+             "    -e            Print the epoch instead of the date\n"
+             "    -a            Print every published field\n"
+             "    -h            Show this page\n");
+      exit(EXIT_SUCCESS);
+      break;
+    }
+  }
+
+  if (optind >= argc) {
+    fprintf(stderr, "term-clock-read: error: no shared memory name given.\n");
+    exit(EXIT_FAILURE);
+  }
+
+  if (!(shm = termclock_shm_open(argv[optind]))) {
+    fprintf(stderr, "term-clock-read: error: couldn't open '%s': %s.\n",
+            argv[optind], strerror(errno));
+    exit(EXIT_FAILURE);
+  }
+
+  if (termclock_shm_read(shm, &snap) == -1) {
+    fprintf(stderr, "term-clock-read: error: couldn't read '%s': %s.\n",
+            argv[optind], strerror(errno));
+    exit(EXIT_FAILURE);
+  }
+  termclock_shm_close(shm);
+
+  if (all)
+    printf("epoch=%lld\nyear=%d\nmon=%d\nmday=%d\nhour=%d\nmin=%d\nsec=%d\n"
+           "wday=%d\nyday=%d\nisdst=%d\nframe=%llu\ndatestr=%s\n",
+           snap.epoch, snap.year, snap.mon, snap.mday, snap.hour, snap.min,
+           snap.sec, snap.wday, snap.yday, snap.isdst, snap.frame, snap.datestr);
+  else if (epoch)
+    printf("%lld\n", snap.epoch);
+  else
+    printf("%s\n", snap.datestr);
+
+  return 0;
+}